@@ -16,6 +16,20 @@ int read_file(const char *filename, sv_t *ret);
 int read_pipe(FILE *pipe, sv_t *ret);
 void usage(FILE *fp);
 
+/// Watches a file for modifications (via inotify).
+typedef struct
+{
+  int fd;
+  char *dir, *name;
+} watch_t;
+
+// Start watching FILENAME.  Returns 0 on success, 1 otherwise (with errno set).
+int watch_init(watch_t *watch, const char *filename);
+// Block until the watched file has been modified.  Returns 0 on success, 1
+// otherwise (with errno set).
+int watch_wait(watch_t *watch);
+void watch_free(watch_t *watch);
+
 #endif
 
 /* Copyright (C) 2026 Aryadev Chavali
@@ -0,0 +1,126 @@
+/* cache.h: Binary serialisation of token streams.
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary:
+
+ A token cache is a compact binary image of a token stream, which can be
+ written to disk and mapped back into memory with no parsing required.  Tokens
+ refer to their source by byte offsets, so a cache is only valid for the exact
+ source buffer it was generated from; the header records the size and hash of
+ that source so stale caches can be detected.  String literals are stored
+ decoded, in the same order as the literal pool they came from.
+
+ Layout (native endianness):
+ - token_cache_header_t
+ - token_cache_header_t.count * token_cache_record_t
+ - token_cache_header_t.literal_count * token_cache_literal_t
+ - token_cache_header_t.literal_bytes bytes of decoded literals
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdio.h>
+
+#include <arl/lexer/token.h>
+#include <arl/lib/base.h>
+#include <arl/lib/sv.h>
+
+#define TOKEN_CACHE_MAGIC   0x544c5241 // "ARLT"
+#define TOKEN_CACHE_VERSION 3
+
+typedef struct
+{
+  u32 magic, version;
+  u64 source_size, source_hash;
+  u64 count;
+  u64 literal_count, literal_bytes;
+} token_cache_header_t;
+
+/// On disk representation of a token_t
+typedef struct
+{
+  u64 byte_location;
+  u32 type;
+  u32 known;
+  // For symbols, the offset into the source buffer and size of the symbol.
+  // For strings, the index and size of the literal.
+  u64 offset, size;
+} token_cache_record_t;
+
+/// On disk representation of a literal, relative to the start of the literal
+/// bytes.
+typedef struct
+{
+  u64 offset, size;
+} token_cache_literal_t;
+
+static_assert(sizeof(token_cache_header_t) == 48,
+              "Expected sizeof(token_cache_header_t) to be 48");
+static_assert(sizeof(token_cache_record_t) == 32,
+              "Expected sizeof(token_cache_record_t) to be 32");
+
+/// A token cache mapped into memory.
+typedef struct
+{
+  void *map;
+  u64 map_size;
+  token_cache_header_t *header;
+  token_cache_record_t *records;
+  token_cache_literal_t *literals;
+  char *literal_bytes;
+} token_cache_t;
+
+/// Types of errors that may occur when loading a token cache
+typedef enum
+{
+  TOKEN_CACHE_ERR_OK = 0,
+  TOKEN_CACHE_ERR_IO,
+  TOKEN_CACHE_ERR_BAD_MAGIC,
+  TOKEN_CACHE_ERR_BAD_VERSION,
+  TOKEN_CACHE_ERR_TRUNCATED,
+  TOKEN_CACHE_ERR_STALE,
+  TOKEN_CACHE_ERR_CORRUPT,
+} token_cache_err_t;
+const char *token_cache_err_to_string(token_cache_err_t err);
+
+// Write a token cache for TOKENS, lexed from SOURCE, to FP.  Returns 0 on
+// success, 1 otherwise.
+int token_cache_write(FILE *fp, token_stream_t *tokens, sv_t source);
+
+// Map the token cache at FILENAME into memory, storing it in RET.  Fails with
+// TOKEN_CACHE_ERR_STALE if the cache was not generated from SOURCE, or
+// TOKEN_CACHE_ERR_CORRUPT if any record or literal is out of bounds.
+token_cache_err_t token_cache_map(const char *filename, sv_t source,
+                                  token_cache_t *ret);
+
+// Unmap a token cache from memory.
+void token_cache_unmap(token_cache_t *cache);
+
+// Number of tokens in CACHE.
+u64 token_cache_count(token_cache_t *cache);
+
+// Reconstruct the INDEX'th token of CACHE, with views into SOURCE.
+token_t token_cache_get(token_cache_t *cache, u64 index, sv_t source);
+
+// The INDEX'th literal of CACHE, viewing the mapped file.
+sv_t token_cache_literal(token_cache_t *cache, u64 index);
+
+// Reconstruct all tokens and literals of CACHE into OUT, which must be empty,
+// with views into SOURCE.
+void token_cache_load(token_cache_t *cache, sv_t source, token_stream_t *out);
+
+#endif
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
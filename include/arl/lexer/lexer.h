@@ -23,17 +23,52 @@ typedef enum
   LEX_ERR_OK = 0,
   LEX_ERR_EXPECTED_SPEECH_MARKS,
   LEX_ERR_UNKNOWN_CHAR,
+  LEX_ERR_UNKNOWN_ESCAPE,
+  LEX_ERR_INVALID_UTF8,
 } lex_err_t;
 const char *lex_err_to_string(lex_err_t err);
 
+/// An error encountered during lexing, alongside where it occurred.
+typedef struct
+{
+  lex_err_t err;
+  u64 byte;
+} lex_diag_t;
+
+VEC_DEFINE(lex_diag_t, lex_diags)
+
 // Generates a token stream from a lex_stream_t, storing it in OUT.  Returns any
-// errors it may generate.
+// errors it may generate.  Source must be valid UTF-8; symbols and strings may
+// contain any non-ASCII character.
 lex_err_t lex_stream(token_stream_t *out, lex_stream_t *stream);
 
+// Generates a token stream from a lex_stream_t like lex_stream, but does not
+// stop at the first error.  Instead, each error is appended to DIAGS and lexing
+// resumes at the next whitespace.  If the buffer isn't valid UTF-8, only the
+// invalid sequences are reported and nothing is lexed.  Stops after MAX_ERRORS
+// errors have been recorded, or never if MAX_ERRORS is 0.  Returns the number
+// of errors recorded.
+u64 lex_stream_recover(token_stream_t *out, lex_stream_t *stream,
+                       lex_diags_t *diags, u64 max_errors);
+
+// Updates TOKENS, previously lexed from OLD, to be the tokens of STREAM's
+// buffer.  Only the region which differs from OLD is lexed again; any tokens
+// after it are shifted into place, and literals no token uses any more are
+// dropped from the pool.  Returns any errors generated, in which case TOKENS
+// (literal pool included) is left untouched and STREAM points at the error.
+lex_err_t lex_stream_relex(token_stream_t *tokens, sv_t old,
+                           lex_stream_t *stream);
+
 // Computes the line and column that STREAM is currently pointing at in its
 // buffer, storing it in LINE and COL.
 void lex_stream_get_line_col(lex_stream_t *stream, u64 *line, u64 *col);
 
+// Walks the bytes [FROM, TO) of STREAM's buffer, updating LINE and COL as it
+// goes.  Allows computing the positions of several (sorted) byte offsets in
+// one pass.
+void lex_stream_walk_line_col(lex_stream_t *stream, u64 from, u64 to, u64 *line,
+                              u64 *col);
+
 #endif
 
 /* Copyright (C) 2026 Aryadev Chavali
@@ -0,0 +1,62 @@
+/* literal.h: Pool of deduplicated string literals.
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary:
+
+ The lexer decodes the escapes of every string literal exactly once, storing
+ the result in a literal pool.  Identical literals are only stored once, so
+ later stages (i.e. codegen) may emit each unique literal once by walking the
+ pool.
+ */
+
+#ifndef LITERAL_H
+#define LITERAL_H
+
+#include <arl/lib/base.h>
+#include <arl/lib/sv.h>
+#include <arl/lib/vec.h>
+
+typedef struct
+{
+  u64 offset, size, hash;
+} literal_t;
+
+VEC_DEFINE(literal_t, literals)
+
+typedef struct
+{
+  // Decoded literals, back to back.
+  vec_t bytes;
+  // Each literal, by index.
+  literals_t literals;
+  // Open addressed hash index over literals: each slot is either 0 (empty) or
+  // 1 + the index of a literal.
+  u64 *slots;
+  u64 capacity;
+} literal_pool_t;
+
+// Return the index of LITERAL in POOL, adding it if it isn't already there.
+u64 literal_pool_intern(literal_pool_t *pool, sv_t literal);
+// Return the literal at INDEX in POOL.  The view is only valid until the next
+// call to literal_pool_intern.
+sv_t literal_pool_get(literal_pool_t *pool, u64 index);
+// Number of unique literals in POOL.
+u64 literal_pool_count(literal_pool_t *pool);
+// Drop every literal from index COUNT onwards from POOL.
+void literal_pool_truncate(literal_pool_t *pool, u64 count);
+void literal_pool_free(literal_pool_t *pool);
+
+#endif
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
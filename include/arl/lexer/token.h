@@ -8,6 +8,7 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <arl/lexer/literal.h>
 #include <arl/lib/base.h>
 #include <arl/lib/sv.h>
 #include <arl/lib/vec.h>
@@ -31,6 +32,12 @@ typedef enum
 
 const char *token_known_to_cstr(token_known_t);
 
+/// String literals, decoded into the literal pool of their token stream.
+typedef struct
+{
+  u64 index, size;
+} token_string_t;
+
 /// Tokens are a tagged union
 typedef struct
 {
@@ -40,21 +47,28 @@ typedef struct
   {
     token_known_t as_known;
     sv_t as_symbol;
-    sv_t as_string;
+    token_string_t as_string;
   };
 } token_t;
 
+VEC_DEFINE(token_t, tokens)
+
 token_t token_known(u64 byte, token_known_t known);
 token_t token_symbol(u64 byte, sv_t symbol);
-token_t token_string(u64 byte, sv_t string);
-void token_print(FILE *fp, token_t *token);
+token_t token_string(u64 byte, u64 index, u64 size);
+// Print TOKEN, resolving any string literals via LITERALS.
+void token_print(FILE *fp, literal_pool_t *literals, token_t *token);
 
-/// Sequence of tokens
+/// Sequence of tokens, with the literals they refer to
 typedef struct
 {
-  vec_t vec;
+  tokens_t vec;
+  literal_pool_t literals;
 } token_stream_t;
 
+// Rebuild the literal pool of STREAM to hold only the literals its tokens use,
+// in order of first use (as lexing it afresh would).
+void token_stream_compact_literals(token_stream_t *stream);
 void token_stream_free(token_stream_t *token);
 void token_stream_print(FILE *fp, token_stream_t *token);
 
@@ -32,6 +32,8 @@ u64 sv_while(const sv_t sv, const char *expected);
 // Return the first index where SV presents a character from EXPECTED (strcspn
 // equivalent)
 u64 sv_till(const sv_t sv, const char *expected);
+// Return a (non cryptographic) hash of the contents of SV
+u64 sv_hash(const sv_t sv);
 
 #endif
 
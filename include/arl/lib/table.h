@@ -0,0 +1,78 @@
+/* table.h: Hash tables keyed by string views.
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary:
+
+ An open addressed hash table in the style of Swiss tables: alongside the slots
+ is an array of control bytes, one per slot, which say whether the slot is
+ empty, deleted, or full (in which case it holds 7 bits of the key's hash).
+ Probing compares a whole group of control bytes against the hash at once, so
+ most lookups touch one group and compare at most one key.
+
+ Entries themselves live in a dense array in insertion order, with the slots
+ indexing into it; iterating a table is stable (insertion order) and doesn't
+ need to walk any empty slots.  Erasing an entry leaves it in place, marked as
+ erased, until enough have built up that the next insertion compacts them away.
+
+ Tables do not own their keys: a key must outlive its entry in the table.
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <arl/lib/base.h>
+#include <arl/lib/sv.h>
+#include <arl/lib/vec.h>
+
+#define TABLE_GROUP_SIZE 16
+
+typedef struct
+{
+  sv_t key;
+  u64 value, hash;
+  bool erased;
+} table_entry_t;
+
+VEC_DEFINE(table_entry_t, table_entries)
+
+typedef struct
+{
+  // Control bytes for each slot, followed by a copy of the first
+  // TABLE_GROUP_SIZE so groups can be loaded from any slot.
+  u8 *ctrl;
+  // Index into entries for each full slot.
+  u64 *slots;
+  table_entries_t entries;
+  // CAPACITY is the number of slots, SIZE the number of live entries and USED
+  // the number of slots that aren't empty (including deleted ones).
+  u64 capacity, size, used;
+} table_t;
+
+// Ensure TABLE can hold at least COUNT entries without growing.
+void table_reserve(table_t *table, u64 count);
+// Associate KEY with VALUE in TABLE, replacing any existing value.
+void table_set(table_t *table, sv_t key, u64 value);
+// Return a pointer to the value associated with KEY in TABLE, or NULL if there
+// isn't one.  The pointer is only valid until TABLE is next modified.
+u64 *table_get(table_t *table, sv_t key);
+// Remove KEY from TABLE.  Returns whether KEY was present.
+bool table_erase(table_t *table, sv_t key);
+// Return the next entry of TABLE in insertion order, starting from *ITER (which
+// should start at 0), or NULL once there are none left.
+table_entry_t *table_next(table_t *table, u64 *iter);
+void table_free(table_t *table);
+
+#endif
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
@@ -0,0 +1,34 @@
+/* utf8.h: UTF-8 validation
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary:
+ */
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <arl/lib/base.h>
+#include <arl/lib/sv.h>
+
+// Is BYTE a UTF-8 continuation byte (i.e. not the start of a character)?
+#define UTF8_IS_CONTINUATION(BYTE) (((u8)(BYTE) & 0xC0) == 0x80)
+
+// Return the index of the first byte of SV which isn't part of a valid UTF-8
+// sequence, or SV.size if all of SV is valid UTF-8.  Overlong encodings,
+// surrogates and code points past U+10FFFF are all invalid.
+u64 utf8_validate(const sv_t sv);
+
+#endif
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
@@ -12,6 +12,8 @@
 
 #include <assert.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <arl/lib/base.h>
 
@@ -60,6 +62,70 @@ void vec_clone(vec_t *v2, vec_t *v1);
 // Helper macro to use a vector as a type generic (but homogeneous) container.
 #define VEC_GET(VEC, INDEX, TYPE) (((TYPE *)vec_data(VEC))[INDEX])
 
+/*
+  Type specialised vectors.
+
+  VEC_DEFINE(TYPE, NAME) defines NAME_t, a vector of TYPE which counts elements
+  rather than bytes and always lives on the heap.  There's no small buffer, so
+  accessing an element is just `vec.data[i]`, with no branch for the compiler to
+  trip over in loops.  Alongside it come the following inline functions:
+  - NAME_reserve(vec, count): ensure space for at least COUNT elements in total
+  - NAME_push(vec, item): append ITEM
+  - NAME_push_n(vec, items, count): append COUNT elements from ITEMS
+  - NAME_pop(vec): remove and return the last element
+  - NAME_reset(vec): remove all elements, keeping the allocation
+  - NAME_free(vec): free the allocation
+
+  A zero initialised NAME_t is a valid, empty vector.
+ */
+#define VEC_DEFINE(TYPE, NAME)                                                 \
+  typedef struct                                                               \
+  {                                                                            \
+    TYPE *data;                                                                \
+    u64 count, capacity;                                                       \
+  } NAME##_t;                                                                  \
+                                                                               \
+  static inline void NAME##_reserve(NAME##_t *vec, u64 count)                  \
+  {                                                                            \
+    if (vec->capacity >= count)                                                \
+      return;                                                                  \
+    vec->capacity = MAX(vec->capacity * VEC_MULT, count);                      \
+    vec->data     = realloc(vec->data, vec->capacity * sizeof(TYPE));          \
+  }                                                                            \
+                                                                               \
+  static inline void NAME##_push(NAME##_t *vec, TYPE item)                     \
+  {                                                                            \
+    NAME##_reserve(vec, vec->count + 1);                                       \
+    vec->data[vec->count++] = item;                                            \
+  }                                                                            \
+                                                                               \
+  static inline void NAME##_push_n(NAME##_t *vec, const TYPE *items,           \
+                                   u64 count)                                  \
+  {                                                                            \
+    if (!count)                                                                \
+      return;                                                                  \
+    NAME##_reserve(vec, vec->count + count);                                   \
+    memcpy(vec->data + vec->count, items, count * sizeof(TYPE));               \
+    vec->count += count;                                                       \
+  }                                                                            \
+                                                                               \
+  static inline TYPE NAME##_pop(NAME##_t *vec)                                 \
+  {                                                                            \
+    assert(vec->count && "Expected non-empty vector");                         \
+    return vec->data[--vec->count];                                            \
+  }                                                                            \
+                                                                               \
+  static inline void NAME##_reset(NAME##_t *vec)                               \
+  {                                                                            \
+    vec->count = 0;                                                            \
+  }                                                                            \
+                                                                               \
+  static inline void NAME##_free(NAME##_t *vec)                                \
+  {                                                                            \
+    free(vec->data);                                                           \
+    *vec = (NAME##_t){0};                                                      \
+  }
+
 #endif
 
 /* Copyright (C) 2026 Aryadev Chavali
@@ -5,8 +5,13 @@
  * Commentary: See /include/arl/cli.h
  */
 
+#define _POSIX_C_SOURCE 200809L
+
+#include <libgen.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
 
 #include <arl/cli.h>
 #include <arl/lib/vec.h>
@@ -64,10 +69,69 @@ int read_pipe(FILE *pipe, sv_t *ret)
 
 void usage(FILE *fp)
 {
-  fprintf(fp, "Usage: arl [FILE]\n"
+  fprintf(fp, "Usage: arl [OPTIONS] [FILE]\n"
               "Compiles [FILE] as ARL source code.\n"
               "  [FILE]: File to compile.\n"
-              "If FILE is \"--\", then read from stdin.\n");
+              "If FILE is \"--\", then read from stdin.\n"
+              "Options:\n"
+              "  --max-errors N: Stop reporting errors after N of them (0 for no "
+              "limit).\n"
+              "  --token-cache CACHE: Load tokens from CACHE if it was generated "
+              "from FILE,\n"
+              "                       otherwise lex FILE and write them to "
+              "CACHE.\n"
+              "  --watch: Compile FILE again whenever it is modified.\n");
+}
+
+int watch_init(watch_t *watch, const char *filename)
+{
+  // NOTE: Editors tend to save by writing a new file and renaming it over the
+  // old one, which would lose a watch on the file itself.  So watch its
+  // directory instead, filtering for events on the file.
+  char *dir_copy  = strdup(filename);
+  char *name_copy = strdup(filename);
+  watch->dir      = strdup(dirname(dir_copy));
+  watch->name     = strdup(basename(name_copy));
+  free(dir_copy);
+  free(name_copy);
+
+  watch->fd = inotify_init();
+  if (watch->fd < 0)
+    return 1;
+  if (inotify_add_watch(watch->fd, watch->dir, IN_CLOSE_WRITE | IN_MOVED_TO) <
+      0)
+    return 1;
+  return 0;
+}
+
+int watch_wait(watch_t *watch)
+{
+  alignas(struct inotify_event) char buffer[4096];
+  while (true)
+  {
+    ssize_t bytes_read = read(watch->fd, buffer, sizeof(buffer));
+    if (bytes_read <= 0)
+      return 1;
+
+    for (char *ptr = buffer; ptr < buffer + bytes_read;)
+    {
+      struct inotify_event *event = (struct inotify_event *)ptr;
+      if (event->len && strcmp(event->name, watch->name) == 0)
+        return 0;
+      ptr += sizeof(*event) + event->len;
+    }
+  }
+}
+
+void watch_free(watch_t *watch)
+{
+  if (!watch)
+    return;
+  if (watch->fd > 0)
+    close(watch->fd);
+  free(watch->dir);
+  free(watch->name);
+  *watch = (watch_t){0};
 }
 
 /* Copyright (C) 2026 Aryadev Chavali
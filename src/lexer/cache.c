@@ -0,0 +1,298 @@
+/* cache.c: Implementation of token caches.
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary: See /include/arl/lexer/cache.h
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <arl/lexer/cache.h>
+#include <arl/lib/vec.h>
+
+const char *token_cache_err_to_string(token_cache_err_t err)
+{
+  switch (err)
+  {
+  case TOKEN_CACHE_ERR_OK:
+    return "OK";
+  case TOKEN_CACHE_ERR_IO:
+    return "IO";
+  case TOKEN_CACHE_ERR_BAD_MAGIC:
+    return "BAD_MAGIC";
+  case TOKEN_CACHE_ERR_BAD_VERSION:
+    return "BAD_VERSION";
+  case TOKEN_CACHE_ERR_TRUNCATED:
+    return "TRUNCATED";
+  case TOKEN_CACHE_ERR_STALE:
+    return "STALE";
+  case TOKEN_CACHE_ERR_CORRUPT:
+    return "CORRUPT";
+  default:
+    FAIL("Unexpected token_cache_err_t value: %d\n", err);
+  }
+}
+
+int token_cache_write(FILE *fp, token_stream_t *tokens, sv_t source)
+{
+  assert(fp && tokens && "Expected valid pointers");
+  u64 count                   = tokens->vec.count;
+  literal_pool_t *literals    = &tokens->literals;
+  token_cache_header_t header = {
+      .magic         = TOKEN_CACHE_MAGIC,
+      .version       = TOKEN_CACHE_VERSION,
+      .source_size   = source.size,
+      .source_hash   = sv_hash(source),
+      .count         = count,
+      .literal_count = literal_pool_count(literals),
+      .literal_bytes = literals->bytes.size,
+  };
+  if (fwrite(&header, sizeof(header), 1, fp) != 1)
+    return 1;
+
+  token_t *items = tokens->vec.data;
+  for (u64 i = 0; i < count; ++i)
+  {
+    token_cache_record_t record = {
+        .byte_location = items[i].byte_location,
+        .type          = items[i].type,
+    };
+    switch (items[i].type)
+    {
+    case TOKEN_TYPE_KNOWN:
+      record.known = items[i].as_known;
+      break;
+    case TOKEN_TYPE_SYMBOL:
+      record.offset = items[i].as_symbol.data - source.data;
+      record.size   = items[i].as_symbol.size;
+      break;
+    case TOKEN_TYPE_STRING:
+      record.offset = items[i].as_string.index;
+      record.size   = items[i].as_string.size;
+      break;
+    case NUM_TOKEN_TYPES:
+    default:
+      FAIL("Unexpected token type: %d\n", items[i].type);
+    }
+    if (fwrite(&record, sizeof(record), 1, fp) != 1)
+      return 1;
+  }
+
+  for (u64 i = 0; i < header.literal_count; ++i)
+  {
+    literal_t item                = literals->literals.data[i];
+    token_cache_literal_t literal = {.offset = item.offset, .size = item.size};
+    if (fwrite(&literal, sizeof(literal), 1, fp) != 1)
+      return 1;
+  }
+  if (header.literal_bytes &&
+      fwrite(vec_data(&literals->bytes), header.literal_bytes, 1, fp) != 1)
+    return 1;
+  return 0;
+}
+
+/// Prototypes for validating token caches
+bool token_cache_fits(token_cache_header_t *header, u64 size);
+bool token_cache_valid(token_cache_t *cache, sv_t source);
+
+// Check every section described by HEADER fits in a file of SIZE bytes, in a
+// way that can't overflow no matter what HEADER says.
+bool token_cache_fits(token_cache_header_t *header, u64 size)
+{
+  u64 remaining = size - sizeof(*header);
+  if (remaining / sizeof(token_cache_record_t) < header->count)
+    return false;
+  remaining -= header->count * sizeof(token_cache_record_t);
+  if (remaining / sizeof(token_cache_literal_t) < header->literal_count)
+    return false;
+  remaining -= header->literal_count * sizeof(token_cache_literal_t);
+  return remaining >= header->literal_bytes;
+}
+
+// Check every literal and record of CACHE is in bounds of its literal bytes and
+// SOURCE respectively, so nothing we hand back can view past either.  Sizes are
+// compared against what remains after offsets, so this can't overflow either.
+bool token_cache_valid(token_cache_t *cache, sv_t source)
+{
+  token_cache_header_t *header = cache->header;
+  for (u64 i = 0; i < header->literal_count; ++i)
+  {
+    token_cache_literal_t literal = cache->literals[i];
+    if (literal.offset > header->literal_bytes ||
+        literal.size > header->literal_bytes - literal.offset)
+      return false;
+  }
+
+  for (u64 i = 0; i < header->count; ++i)
+  {
+    token_cache_record_t record = cache->records[i];
+    if (record.byte_location >= source.size)
+      return false;
+    switch (record.type)
+    {
+    case TOKEN_TYPE_KNOWN:
+      if (record.known >= NUM_TOKEN_KNOWNS)
+        return false;
+      break;
+    case TOKEN_TYPE_SYMBOL:
+      if (record.offset > source.size ||
+          record.size > source.size - record.offset)
+        return false;
+      break;
+    case TOKEN_TYPE_STRING:
+      if (record.offset >= header->literal_count ||
+          record.size != cache->literals[record.offset].size)
+        return false;
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+token_cache_err_t token_cache_map(const char *filename, sv_t source,
+                                  token_cache_t *ret)
+{
+  assert(filename && ret && "Expected valid pointers");
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return TOKEN_CACHE_ERR_IO;
+
+  struct stat st = {0};
+  if (fstat(fd, &st) < 0)
+  {
+    close(fd);
+    return TOKEN_CACHE_ERR_IO;
+  }
+  if ((u64)st.st_size < sizeof(token_cache_header_t))
+  {
+    close(fd);
+    return TOKEN_CACHE_ERR_TRUNCATED;
+  }
+
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file.
+  close(fd);
+  if (map == MAP_FAILED)
+    return TOKEN_CACHE_ERR_IO;
+
+  token_cache_t cache = {
+      .map      = map,
+      .map_size = st.st_size,
+      .header   = map,
+      .records  = (token_cache_record_t *)((token_cache_header_t *)map + 1),
+  };
+  token_cache_header_t *header = cache.header;
+
+  token_cache_err_t err = TOKEN_CACHE_ERR_OK;
+  if (header->magic != TOKEN_CACHE_MAGIC)
+    err = TOKEN_CACHE_ERR_BAD_MAGIC;
+  else if (header->version != TOKEN_CACHE_VERSION)
+    err = TOKEN_CACHE_ERR_BAD_VERSION;
+  else if (!token_cache_fits(header, cache.map_size))
+    err = TOKEN_CACHE_ERR_TRUNCATED;
+  else if (cache.header->source_size != source.size ||
+           cache.header->source_hash != sv_hash(source))
+    err = TOKEN_CACHE_ERR_STALE;
+
+  if (!err)
+  {
+    cache.literals = (token_cache_literal_t *)(cache.records + header->count);
+    cache.literal_bytes = (char *)(cache.literals + header->literal_count);
+    if (!token_cache_valid(&cache, source))
+      err = TOKEN_CACHE_ERR_CORRUPT;
+  }
+
+  if (err)
+  {
+    token_cache_unmap(&cache);
+    return err;
+  }
+
+  *ret = cache;
+  return TOKEN_CACHE_ERR_OK;
+}
+
+void token_cache_unmap(token_cache_t *cache)
+{
+  if (!cache || !cache->map)
+    return;
+  munmap(cache->map, cache->map_size);
+  *cache = (token_cache_t){0};
+}
+
+u64 token_cache_count(token_cache_t *cache)
+{
+  return cache->header->count;
+}
+
+token_t token_cache_get(token_cache_t *cache, u64 index, sv_t source)
+{
+  assert(index < token_cache_count(cache) && "Expected index in bounds");
+  token_cache_record_t record = cache->records[index];
+  switch (record.type)
+  {
+  case TOKEN_TYPE_KNOWN:
+    return token_known(record.byte_location, record.known);
+  case TOKEN_TYPE_SYMBOL:
+    return token_symbol(record.byte_location,
+                        SV(source.data + record.offset, record.size));
+  case TOKEN_TYPE_STRING:
+    return token_string(record.byte_location, record.offset, record.size);
+  default:
+    FAIL("Unexpected token type: %d\n", record.type);
+  }
+}
+
+sv_t token_cache_literal(token_cache_t *cache, u64 index)
+{
+  assert(index < cache->header->literal_count && "Expected index in bounds");
+  token_cache_literal_t literal = cache->literals[index];
+  return SV(cache->literal_bytes + literal.offset, literal.size);
+}
+
+void token_cache_load(token_cache_t *cache, sv_t source, token_stream_t *out)
+{
+  assert(cache && out && "Expected valid pointers");
+  assert(literal_pool_count(&out->literals) == 0 && "Expected empty stream");
+
+  // Literals were deduplicated when they were written, so interning them in
+  // order should preserve their indices.  A cache with duplicate literals is
+  // still in bounds though, so remap string tokens to wherever their literal
+  // actually ended up.
+  u64 literal_count = cache->header->literal_count;
+  u64 *indices      = malloc(literal_count * sizeof(*indices));
+  for (u64 i = 0; i < literal_count; ++i)
+    indices[i] =
+        literal_pool_intern(&out->literals, token_cache_literal(cache, i));
+
+  u64 count = token_cache_count(cache);
+  tokens_reserve(&out->vec, out->vec.count + count);
+  for (u64 i = 0; i < count; ++i)
+  {
+    token_t token = token_cache_get(cache, i, source);
+    if (token.type == TOKEN_TYPE_STRING)
+      token.as_string.index = indices[token.as_string.index];
+    out->vec.data[out->vec.count++] = token;
+  }
+  free(indices);
+}
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
@@ -5,17 +5,62 @@
  * Commentary: See /include/arl/lexer/lexer.h
  */
 
-#include <ctype.h>
 #include <string.h>
 
 #include <arl/lexer/lexer.h>
 #include <arl/lexer/token.h>
 #include <arl/lib/sv.h>
+#include <arl/lib/utf8.h>
 
-/// Expected characters in a symbol
-static const char *SYMBOL_CHARS =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz!#$%&'()*+,-./"
-    ":;<=>?@\\^_`{|}~0123456789";
+/// Classes of characters the lexer cares about
+typedef enum
+{
+  CHAR_SPACE  = 1,
+  CHAR_SYMBOL = 2,
+  CHAR_DIGIT  = 4,
+  // Ends a run of plain bytes within a string literal.
+  CHAR_STRING = 8,
+} char_class_t;
+
+#define CS CHAR_SPACE
+#define CY CHAR_SYMBOL
+#define CD (CHAR_SYMBOL | CHAR_DIGIT)
+#define CQ CHAR_STRING
+#define CE (CHAR_SYMBOL | CHAR_STRING)
+
+/// Class of every byte.  Symbols may use any printable ASCII character other
+/// than speech marks and square brackets (reserved for later syntax), or any
+/// non-ASCII character; by the time we look at this, the buffer has been
+/// validated as UTF-8 so any byte >= 0x80 is part of a well formed character.
+/// Whitespace is the same set as isspace in the C locale.  Within strings, only
+/// speech marks and backslashes are special; every other byte (NUL included) is
+/// taken as is.
+static const u8 CHAR_CLASSES[256] = {
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  CS, CS, CS, CS, CS, 0,  0,  // 0x00
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  // 0x10
+    CS, CY, CQ, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0x20
+    CD, CD, CD, CD, CD, CD, CD, CD, CD, CD, CY, CY, CY, CY, CY, CY, // 0x30
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0x40
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, 0,  CE, 0,  CY, CY, // 0x50
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0x60
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, 0,  // 0x70
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0x80
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0x90
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0xA0
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0xB0
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0xC0
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0xD0
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0xE0
+    CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, CY, // 0xF0
+};
+
+#undef CS
+#undef CY
+#undef CD
+#undef CQ
+#undef CE
+
+#define CHAR_IS(CLASS, C) (CHAR_CLASSES[(u8)(C)] & (CLASS))
 
 const char *lex_err_to_string(lex_err_t err)
 {
@@ -27,6 +72,10 @@ const char *lex_err_to_string(lex_err_t err)
     return "EXPECTED_SPEECH_MARKS";
   case LEX_ERR_UNKNOWN_CHAR:
     return "UNKNOWN_CHAR";
+  case LEX_ERR_UNKNOWN_ESCAPE:
+    return "UNKNOWN_ESCAPE";
+  case LEX_ERR_INVALID_UTF8:
+    return "INVALID_UTF8";
   default:
     FAIL("Unexpected lex_err_t value: %d\n", err);
   }
@@ -41,7 +90,15 @@ u64 stream_size(lex_stream_t *stream);
 void lex_stream_get_line_col(lex_stream_t *stream, u64 *line, u64 *col)
 {
   assert(stream && line && col && "Expected valid pointers.");
-  for (u64 i = 0; i < stream->byte; ++i)
+  lex_stream_walk_line_col(stream, 0, stream->byte, line, col);
+}
+
+void lex_stream_walk_line_col(lex_stream_t *stream, u64 from, u64 to, u64 *line,
+                              u64 *col)
+{
+  assert(stream && line && col && "Expected valid pointers.");
+  to = MIN(to, stream_size(stream));
+  for (u64 i = from; i < to; ++i)
   {
     char c = stream->contents.data[i];
     if (c == '\n')
@@ -49,7 +106,8 @@ void lex_stream_get_line_col(lex_stream_t *stream, u64 *line, u64 *col)
       *line += 1;
       *col = 0;
     }
-    else
+    // Columns count characters, not bytes.
+    else if (!UTF8_IS_CONTINUATION(c))
     {
       *col += 1;
     }
@@ -57,72 +115,373 @@ void lex_stream_get_line_col(lex_stream_t *stream, u64 *line, u64 *col)
 }
 
 /// Prototypes for lexing subroutines
-lex_err_t lex_string(lex_stream_t *stream, token_t *ret);
+lex_err_t lex_string(lex_stream_t *stream, literal_pool_t *literals,
+                     token_t *ret);
 lex_err_t lex_symbol(lex_stream_t *stream, token_t *ret);
+lex_err_t lex_next(tokens_t *out, literal_pool_t *literals,
+                   lex_stream_t *stream);
 
 lex_err_t lex_stream(token_stream_t *out, lex_stream_t *stream)
 {
   assert(out && stream && "Expected valid pointers");
+  // Validate the whole buffer up front, so the rest of the lexer can treat any
+  // non-ASCII byte as part of a well formed character.
+  u64 invalid = utf8_validate(sv_chop_left(stream->contents, stream->byte));
+  if (stream->byte + invalid < stream_size(stream))
+  {
+    stream->byte += invalid;
+    return LEX_ERR_INVALID_UTF8;
+  }
+
+  while (!stream_eos(stream))
+  {
+    lex_err_t perr = lex_next(&out->vec, &out->literals, stream);
+    if (perr)
+      return perr;
+  }
+  return LEX_ERR_OK;
+}
+
+u64 lex_stream_recover(token_stream_t *out, lex_stream_t *stream,
+                       lex_diags_t *diags, u64 max_errors)
+{
+  assert(out && stream && diags && "Expected valid pointers");
+  u64 errors = 0;
+
+  // Report every invalid UTF-8 sequence up front.  If there are any, we don't
+  // lex at all: see lex_stream.
+  u64 byte = stream->byte;
+  while (max_errors == 0 || errors < max_errors)
+  {
+    byte += utf8_validate(sv_chop_left(stream->contents, byte));
+    if (byte >= stream_size(stream))
+      break;
+    lex_diags_push(diags,
+                   (lex_diag_t){.err = LEX_ERR_INVALID_UTF8, .byte = byte});
+    ++errors;
+
+    // Skip past the rest of the broken sequence.
+    ++byte;
+    while (byte < stream_size(stream) &&
+           UTF8_IS_CONTINUATION(stream->contents.data[byte]))
+      ++byte;
+  }
+  if (errors)
+  {
+    stream->byte = MIN(byte, stream_size(stream));
+    return errors;
+  }
+
+  while (!stream_eos(stream) && (max_errors == 0 || errors < max_errors))
+  {
+    u64 start      = stream->byte;
+    lex_err_t perr = lex_next(&out->vec, &out->literals, stream);
+    if (!perr)
+      continue;
+
+    lex_diags_push(diags, (lex_diag_t){.err = perr, .byte = start});
+    ++errors;
+
+    // Resynchronise at the next whitespace; whatever garbage lies between here
+    // and there can't be trusted to lex into anything meaningful.
+    stream->byte = start;
+    while (!stream_eos(stream) && !CHAR_IS(CHAR_SPACE, stream_peek(stream)))
+      stream_advance(stream, 1);
+  }
+  return errors;
+}
+
+/// Prototypes for incremental lexing
+u64 token_end(sv_t source, token_t *token);
+void token_rebase(token_t *token, sv_t old, sv_t new, i64 delta);
+
+lex_err_t lex_stream_relex(token_stream_t *tokens, sv_t old,
+                           lex_stream_t *stream)
+{
+  assert(tokens && stream && "Expected valid pointers");
+  sv_t new       = stream->contents;
+  token_t *items = tokens->vec.data;
+  u64 count      = tokens->vec.count;
+
+  // Find the region that has changed: [prefix, old.size - suffix) in OLD,
+  // [prefix, new.size - suffix) in NEW.
+  u64 limit = MIN(old.size, new.size), prefix = 0, suffix = 0;
+  while (prefix < limit && old.data[prefix] == new.data[prefix])
+    ++prefix;
+  while (suffix < limit - prefix &&
+         old.data[old.size - suffix - 1] == new.data[new.size - suffix - 1])
+    ++suffix;
+  u64 edit_end = new.size - suffix;
+  i64 delta    = (i64)new.size - (i64)old.size;
+
+  // OLD was valid UTF-8, so only the characters overlapping the edit need
+  // validating.  Characters are at most 4 bytes, so the one overlapping the
+  // start of the edit begins at most 3 bytes before it.
+  u64 check_from = prefix < 3 ? 0 : prefix - 3, check_to = edit_end;
+  while (check_from < prefix && UTF8_IS_CONTINUATION(new.data[check_from]))
+    ++check_from;
+  while (check_to < new.size && UTF8_IS_CONTINUATION(new.data[check_to]))
+    ++check_to;
+  u64 invalid = utf8_validate(SV(new.data + check_from, check_to - check_from));
+  if (check_from + invalid < check_to)
+  {
+    stream->byte = check_from + invalid;
+    return LEX_ERR_INVALID_UTF8;
+  }
+
+  // Tokens are sorted, so binary search for the first token which reaches the
+  // edit; every token before it is untouched.
+  u64 first = 0;
+  for (u64 hi = count; first < hi;)
+  {
+    u64 mid = first + (hi - first) / 2;
+    if (token_end(old, items + mid) < prefix)
+      first = mid + 1;
+    else
+      hi = mid;
+  }
+
+  // If the edit lies within that token, we have to start lexing from the token
+  // itself.  Otherwise the edit lies in whitespace, which has no state to
+  // speak of.
+  stream->byte = prefix;
+  if (first < count && items[first].byte_location < prefix)
+    stream->byte = items[first].byte_location;
+
+  // Fresh literals go straight into the pool, so remember where it ended in
+  // case we have to back out.
+  u64 literal_count = literal_pool_count(&tokens->literals);
+  tokens_t fresh    = {0};
+  u64 fresh_count   = 0, resync = count;
   while (!stream_eos(stream))
   {
-    char cur = stream_peek(stream);
-    if (isspace(cur))
+    lex_err_t perr = lex_next(&fresh, &tokens->literals, stream);
+    if (perr)
     {
-      while (isspace(cur) && !stream_eos(stream))
-      {
-        stream_advance(stream, 1);
-        cur = stream_peek(stream);
-      }
+      tokens_free(&fresh);
+      literal_pool_truncate(&tokens->literals, literal_count);
+      return perr;
     }
-    else if (cur == '"')
+    else if (fresh.count == fresh_count)
+      continue;
+
+    // Lexing only depends on our position and the bytes ahead of it.  So if
+    // this token is past the edit and starts exactly where an old token did,
+    // we'd just regenerate the old tokens from here on out.
+    token_t *last = fresh.data + fresh_count;
+    if (last->byte_location >= edit_end)
     {
-      // we make a copy for lex_string to mess with
-      token_t ret    = {0};
-      lex_err_t perr = lex_string(stream, &ret);
-      if (perr)
-        return perr;
-      vec_append(&out->vec, &ret, sizeof(ret));
+      u64 old_byte = last->byte_location - delta, lo = first, hi = count;
+      while (lo < hi)
+      {
+        u64 mid = lo + (hi - lo) / 2;
+        if (items[mid].byte_location < old_byte)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      if (lo < count && items[lo].byte_location == old_byte)
+      {
+        resync = lo;
+        break;
+      }
     }
-    else if (strchr(SYMBOL_CHARS, cur) && !isdigit(cur))
-    {
-      // we make a copy for lex_symbol to mess with
-      token_t ret    = {0};
-      lex_err_t perr = lex_symbol(stream, &ret);
-      if (perr)
-        return perr;
+    ++fresh_count;
+  }
 
-      vec_append(&out->vec, &ret, sizeof(ret));
-    }
-    else
+  LOG("Relexed %lu tokens in [%lu, %lu), reused %lu\n", fresh_count,
+      prefix, edit_end, count - (resync - first));
+
+  // If strings were thrown away or lexed afresh, some literals may no longer be
+  // used by any token, or be out of order with respect to their first use.
+  bool stale_literals = false;
+  for (u64 i = first; i < resync && !stale_literals; ++i)
+    stale_literals = items[i].type == TOKEN_TYPE_STRING;
+  for (u64 i = 0; i < fresh_count && !stale_literals; ++i)
+    stale_literals = fresh.data[i].type == TOKEN_TYPE_STRING;
+
+  // Splice the fresh tokens in between the untouched ones, which need to be
+  // rebased onto NEW.
+  u64 tail = count - resync;
+  tokens_reserve(&tokens->vec, first + fresh_count + tail);
+  items = tokens->vec.data;
+  if (tail)
+    memmove(items + first + fresh_count, items + resync,
+            tail * sizeof(token_t));
+  if (fresh_count)
+    memcpy(items + first, fresh.data, fresh_count * sizeof(token_t));
+  tokens->vec.count = first + fresh_count + tail;
+
+  for (u64 i = 0; i < first; ++i)
+    token_rebase(items + i, old, new, 0);
+  for (u64 i = first + fresh_count; i < first + fresh_count + tail; ++i)
+    token_rebase(items + i, old, new, delta);
+
+  tokens_free(&fresh);
+  if (stale_literals)
+    token_stream_compact_literals(tokens);
+  return LEX_ERR_OK;
+}
+
+u64 token_end(sv_t source, token_t *token)
+{
+  switch (token->type)
+  {
+  case TOKEN_TYPE_KNOWN:
+    return token->byte_location + strlen(token_known_to_cstr(token->as_known));
+  case TOKEN_TYPE_SYMBOL:
+    return token->byte_location + token->as_symbol.size;
+  case TOKEN_TYPE_STRING:
+  {
+    // The literal has been decoded, so find the closing speech mark in the
+    // source.
+    u64 i = token->byte_location + 1;
+    while (i < source.size && source.data[i] != '"')
+      i += source.data[i] == '\\' ? 2 : 1;
+    return MIN(i + 1, source.size);
+  }
+  case NUM_TOKEN_TYPES:
+  default:
+    FAIL("Unexpected token type: %d\n", token->type);
+  }
+}
+
+void token_rebase(token_t *token, sv_t old, sv_t new, i64 delta)
+{
+  token->byte_location += delta;
+  switch (token->type)
+  {
+  case TOKEN_TYPE_KNOWN:
+  case TOKEN_TYPE_STRING:
+    break;
+  case TOKEN_TYPE_SYMBOL:
+    token->as_symbol.data =
+        new.data + (token->as_symbol.data - old.data) + delta;
+    break;
+  case NUM_TOKEN_TYPES:
+  default:
+    FAIL("Unexpected token type: %d\n", token->type);
+  }
+}
+
+// Lexes the next item in STREAM: either a run of whitespace, or a single token
+// which is appended to OUT.
+lex_err_t lex_next(tokens_t *out, literal_pool_t *literals,
+                   lex_stream_t *stream)
+{
+  char cur = stream_peek(stream);
+  if (CHAR_IS(CHAR_SPACE, cur))
+  {
+    while (CHAR_IS(CHAR_SPACE, cur) && !stream_eos(stream))
     {
-      return LEX_ERR_UNKNOWN_CHAR;
+      stream_advance(stream, 1);
+      cur = stream_peek(stream);
     }
   }
+  else if (cur == '"')
+  {
+    // we make a copy for lex_string to mess with
+    token_t ret    = {0};
+    lex_err_t perr = lex_string(stream, literals, &ret);
+    if (perr)
+      return perr;
+    tokens_push(out, ret);
+  }
+  else if (CHAR_IS(CHAR_SYMBOL, cur) && !CHAR_IS(CHAR_DIGIT, cur))
+  {
+    // we make a copy for lex_symbol to mess with
+    token_t ret    = {0};
+    lex_err_t perr = lex_symbol(stream, &ret);
+    if (perr)
+      return perr;
+
+    tokens_push(out, ret);
+  }
+  else
+  {
+    return LEX_ERR_UNKNOWN_CHAR;
+  }
   return LEX_ERR_OK;
 }
 
-lex_err_t lex_string(lex_stream_t *stream, token_t *ret)
+lex_err_t lex_string(lex_stream_t *stream, literal_pool_t *literals,
+                     token_t *ret)
 {
+  u64 start = stream->byte;
   // Increment the cursor just past the first speechmark
   stream_advance(stream, 1);
-  sv_t string = sv_chop_left(stream->contents, stream->byte);
-  string.size = sv_till(string, "\"");
 
-  // If we're at the edge of the stream, there must not have been any
-  // speechmarks.
-  if (string.size + stream->byte == stream_size(stream))
-    return LEX_ERR_EXPECTED_SPEECH_MARKS;
+  // Decode escapes as we go, so no later stage has to deal with them.
+  vec_t decoded  = {0};
+  lex_err_t perr = LEX_ERR_OK;
+  while (true)
+  {
+    sv_t chunk = sv_chop_left(stream->contents, stream->byte);
+    u64 size   = 0;
+    while (size < chunk.size && !CHAR_IS(CHAR_STRING, chunk.data[size]))
+      ++size;
+    chunk.size = size;
+    vec_append(&decoded, chunk.data, chunk.size);
+    stream_advance(stream, chunk.size);
 
-  // `string` is well defined, package and throw it back.
-  *ret = token_string(stream->byte - 1, string);
-  stream_advance(stream, string.size + 1);
-  return LEX_ERR_OK;
+    // If we're at the edge of the stream, there must not have been any
+    // speechmarks.
+    if (stream_eos(stream))
+    {
+      perr = LEX_ERR_EXPECTED_SPEECH_MARKS;
+      goto end;
+    }
+    else if (stream_peek(stream) == '"')
+      break;
+
+    // Otherwise we're at an escape
+    stream_advance(stream, 1);
+    char escaped = 0;
+    switch (stream_peek(stream))
+    {
+    case 'n':
+      escaped = '\n';
+      break;
+    case 't':
+      escaped = '\t';
+      break;
+    case 'r':
+      escaped = '\r';
+      break;
+    case '0':
+      escaped = '\0';
+      break;
+    case '\\':
+    case '"':
+      escaped = stream_peek(stream);
+      break;
+    default:
+      // Includes the end of the stream, where stream_peek gives us '\0'.
+      perr = stream_eos(stream) ? LEX_ERR_EXPECTED_SPEECH_MARKS
+                                : LEX_ERR_UNKNOWN_ESCAPE;
+      goto end;
+    }
+    vec_append_byte(&decoded, escaped);
+    stream_advance(stream, 1);
+  }
+
+  // The literal is well defined, pool it and throw it back.
+  u64 index =
+      literal_pool_intern(literals, SV(vec_data(&decoded), decoded.size));
+  *ret = token_string(start, index, decoded.size);
+  stream_advance(stream, 1);
+end:
+  vec_free(&decoded);
+  return perr;
 }
 
 lex_err_t lex_symbol(lex_stream_t *stream, token_t *ret)
 {
   sv_t symbol = sv_chop_left(stream->contents, stream->byte);
-  symbol.size = sv_while(symbol, SYMBOL_CHARS);
+  u64 size    = 0;
+  while (size < symbol.size && CHAR_IS(CHAR_SYMBOL, symbol.data[size]))
+    ++size;
+  symbol.size = size;
 
   // see if symbol is one of the already known symbols
   static_assert(NUM_TOKEN_KNOWNS == 1, "Expected number of TOKEN_KNOWNs");
@@ -0,0 +1,118 @@
+/* literal.c: Implementation of literal pools.
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary: See /include/arl/lexer/literal.h
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <arl/lexer/literal.h>
+
+#define LITERAL_POOL_INITIAL_CAPACITY 16
+
+/// Prototypes for the hash index
+void literal_pool_grow(literal_pool_t *pool);
+void literal_pool_reindex(literal_pool_t *pool, u64 capacity);
+
+u64 literal_pool_intern(literal_pool_t *pool, sv_t literal)
+{
+  assert(pool && "Expected valid pointer");
+  // Keep the load factor at or below a half.
+  if ((literal_pool_count(pool) + 1) * 2 > pool->capacity)
+    literal_pool_grow(pool);
+
+  u64 hash = sv_hash(literal);
+  u64 mask = pool->capacity - 1;
+  u64 slot = hash & mask;
+  for (; pool->slots[slot]; slot = (slot + 1) & mask)
+  {
+    u64 index      = pool->slots[slot] - 1;
+    literal_t item = pool->literals.data[index];
+    if (item.hash == hash && item.size == literal.size &&
+        memcmp(&VEC_GET(&pool->bytes, item.offset, char), literal.data,
+               literal.size) == 0)
+      return index;
+  }
+
+  u64 index      = literal_pool_count(pool);
+  literal_t item = {
+      .offset = pool->bytes.size,
+      .size   = literal.size,
+      .hash   = hash,
+  };
+  vec_append(&pool->bytes, literal.data, literal.size);
+  literals_push(&pool->literals, item);
+  pool->slots[slot] = index + 1;
+  return index;
+}
+
+sv_t literal_pool_get(literal_pool_t *pool, u64 index)
+{
+  assert(index < literal_pool_count(pool) && "Expected index in bounds");
+  literal_t item = pool->literals.data[index];
+  return SV(&VEC_GET(&pool->bytes, item.offset, char), item.size);
+}
+
+u64 literal_pool_count(literal_pool_t *pool)
+{
+  return pool->literals.count;
+}
+
+void literal_pool_truncate(literal_pool_t *pool, u64 count)
+{
+  assert(count <= literal_pool_count(pool) && "Expected count in bounds");
+  if (count == literal_pool_count(pool))
+    return;
+  pool->bytes.size     = pool->literals.data[count].offset;
+  pool->literals.count = count;
+  literal_pool_reindex(pool, pool->capacity);
+}
+
+void literal_pool_grow(literal_pool_t *pool)
+{
+  literal_pool_reindex(pool, pool->capacity ? pool->capacity * 2
+                                            : LITERAL_POOL_INITIAL_CAPACITY);
+}
+
+// Rebuild the hash index of POOL with CAPACITY slots.
+void literal_pool_reindex(literal_pool_t *pool, u64 capacity)
+{
+  u64 *slots = calloc(capacity, sizeof(*slots));
+
+  // We stored the hashes, so rehashing is just reinsertion.
+  for (u64 i = 0; i < literal_pool_count(pool); ++i)
+  {
+    u64 slot = pool->literals.data[i].hash & (capacity - 1);
+    while (slots[slot])
+      slot = (slot + 1) & (capacity - 1);
+    slots[slot] = i + 1;
+  }
+
+  free(pool->slots);
+  pool->slots    = slots;
+  pool->capacity = capacity;
+}
+
+void literal_pool_free(literal_pool_t *pool)
+{
+  if (!pool)
+    return;
+  vec_free(&pool->bytes);
+  literals_free(&pool->literals);
+  free(pool->slots);
+  *pool = (literal_pool_t){0};
+}
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
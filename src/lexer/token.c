@@ -29,12 +29,12 @@ token_t token_known(u64 byte, token_known_t known)
   };
 }
 
-token_t token_string(u64 byte, sv_t string)
+token_t token_string(u64 byte, u64 index, u64 size)
 {
   return (token_t){
       .byte_location = byte,
       .type          = TOKEN_TYPE_STRING,
-      .as_string     = string,
+      .as_string     = {.index = index, .size = size},
   };
 }
 
@@ -47,7 +47,37 @@ token_t token_symbol(u64 byte, sv_t symbol)
   };
 }
 
-void token_print(FILE *fp, token_t *token)
+// Print STRING with any special characters escaped again.
+void token_print_escaped(FILE *fp, sv_t string)
+{
+  for (u64 i = 0; i < string.size; ++i)
+  {
+    char c = string.data[i];
+    switch (c)
+    {
+    case '\n':
+      fprintf(fp, "\\n");
+      break;
+    case '\t':
+      fprintf(fp, "\\t");
+      break;
+    case '\r':
+      fprintf(fp, "\\r");
+      break;
+    case '\0':
+      fprintf(fp, "\\0");
+      break;
+    case '\\':
+    case '"':
+      fprintf(fp, "\\%c", c);
+      break;
+    default:
+      fputc(c, fp);
+    }
+  }
+}
+
+void token_print(FILE *fp, literal_pool_t *literals, token_t *token)
 {
   if (!token)
   {
@@ -63,7 +93,10 @@ void token_print(FILE *fp, token_t *token)
     fprintf(fp, "SYMBOL(" PR_SV ")", SV_FMT(token->as_symbol));
     break;
   case TOKEN_TYPE_STRING:
-    fprintf(fp, "STRING(" PR_SV ")", SV_FMT(token->as_string));
+    fprintf(fp, "STRING(");
+    token_print_escaped(fp,
+                        literal_pool_get(literals, token->as_string.index));
+    fprintf(fp, ")");
     break;
   case NUM_TOKEN_TYPES:
   default:
@@ -79,27 +112,43 @@ void token_stream_print(FILE *fp, token_stream_t *token)
     return;
   }
   fprintf(fp, "{");
-  if (token->vec.size == 0)
+  if (token->vec.count == 0)
   {
     fprintf(fp, "}\n");
     return;
   }
 
   fprintf(fp, "\n");
-  for (u64 i = 0; i < token->vec.size / sizeof(token_t); ++i)
+  for (u64 i = 0; i < token->vec.count; ++i)
   {
-    token_t item = VEC_GET(&token->vec, i, token_t);
     fprintf(fp, "\t[%lu]: ", i);
-    token_print(fp, &item);
+    token_print(fp, &token->literals, token->vec.data + i);
     fprintf(fp, "\n");
   }
   fprintf(fp, "}");
 }
 
+void token_stream_compact_literals(token_stream_t *stream)
+{
+  assert(stream && "Expected valid pointer");
+  literal_pool_t literals = {0};
+  for (u64 i = 0; i < stream->vec.count; ++i)
+  {
+    token_t *token = stream->vec.data + i;
+    if (token->type != TOKEN_TYPE_STRING)
+      continue;
+    sv_t literal = literal_pool_get(&stream->literals, token->as_string.index);
+    token->as_string.index = literal_pool_intern(&literals, literal);
+  }
+  literal_pool_free(&stream->literals);
+  stream->literals = literals;
+}
+
 void token_stream_free(token_stream_t *stream)
 {
-  // we can free the vector itself and we're done
-  vec_free(&stream->vec);
+  // we can free the vector and literals and we're done
+  tokens_free(&stream->vec);
+  literal_pool_free(&stream->literals);
 }
 
 /* Copyright (C) 2026 Aryadev Chavali
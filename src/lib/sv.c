@@ -49,6 +49,33 @@ u64 sv_till(const sv_t sv, const char *expected)
   return i;
 }
 
+u64 sv_hash(const sv_t sv)
+{
+  // Consume 8 bytes at a time, then run the result through murmur3's finaliser
+  // so every bit of input affects every bit of output.
+  u64 hash = 0x9e3779b97f4a7c15 ^ sv.size, i = 0;
+  for (; i + 8 <= sv.size; i += 8)
+  {
+    u64 word;
+    memcpy(&word, sv.data + i, sizeof(word));
+    hash ^= word * 0xbf58476d1ce4e5b9;
+    hash = ((hash << 27) | (hash >> 37)) * 0x94d049bb133111eb;
+  }
+  if (i < sv.size)
+  {
+    u64 word = 0;
+    memcpy(&word, sv.data + i, sv.size - i);
+    hash ^= word * 0xbf58476d1ce4e5b9;
+  }
+
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccd;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53;
+  hash ^= hash >> 33;
+  return hash;
+}
+
 /* Copyright (C) 2026 Aryadev Chavali
 
  * This program is distributed in the hope that it will be useful,
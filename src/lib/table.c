@@ -0,0 +1,240 @@
+/* table.c: Hash table implementation
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary: See /include/arl/lib/table.h
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <arl/lib/table.h>
+
+// Control bytes: full slots hold the bottom 7 bits of their hash, so only
+// empty and deleted slots have the top bit set.
+#define CTRL_EMPTY   0x80
+#define CTRL_DELETED 0xFE
+#define HASH_H1(H)   ((H) >> 7)
+#define HASH_H2(H)   ((u8)((H) & 0x7F))
+
+/// Prototypes for groups of control bytes
+u32 group_match(const u8 *ctrl, u8 byte);
+u32 group_match_free(const u8 *ctrl);
+
+/// Prototypes for table internals
+u64 table_find(table_t *table, sv_t key, u64 hash);
+u64 table_find_free(table_t *table, u64 hash);
+void table_set_ctrl(table_t *table, u64 slot, u8 byte);
+void table_rehash(table_t *table, u64 count);
+
+// Bitmask of which control bytes in the group starting at CTRL equal BYTE.
+u32 group_match(const u8 *ctrl, u8 byte)
+{
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte)));
+#else
+  u32 mask = 0;
+  for (u32 i = 0; i < TABLE_GROUP_SIZE; ++i)
+    mask |= (u32)(ctrl[i] == byte) << i;
+  return mask;
+#endif
+}
+
+// Bitmask of which slots in the group starting at CTRL are empty or deleted.
+u32 group_match_free(const u8 *ctrl)
+{
+#ifdef __SSE2__
+  return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+  u32 mask = 0;
+  for (u32 i = 0; i < TABLE_GROUP_SIZE; ++i)
+    mask |= (u32)(ctrl[i] >> 7) << i;
+  return mask;
+#endif
+}
+
+// NOTE: Probing moves a group further along each step (triangular probing).
+// As the capacity is a power of two, this visits every group before repeating.
+
+// Returns the slot holding KEY, or the capacity of TABLE if there isn't one.
+u64 table_find(table_t *table, sv_t key, u64 hash)
+{
+  if (!table->capacity)
+    return 0;
+  u64 mask = table->capacity - 1;
+  for (u64 pos = HASH_H1(hash) & mask, stride = 0;;
+       stride += TABLE_GROUP_SIZE, pos = (pos + stride) & mask)
+  {
+    for (u32 matches = group_match(table->ctrl + pos, HASH_H2(hash)); matches;
+         matches &= matches - 1)
+    {
+      u64 slot             = (pos + __builtin_ctz(matches)) & mask;
+      table_entry_t *entry = table->entries.data + table->slots[slot];
+      if (entry->hash == hash && entry->key.size == key.size &&
+          (!key.size || memcmp(entry->key.data, key.data, key.size) == 0))
+        return slot;
+    }
+    // An empty slot means KEY would have been placed here or earlier.
+    if (group_match(table->ctrl + pos, CTRL_EMPTY))
+      return table->capacity;
+  }
+}
+
+// Returns the first slot a key with HASH could be placed in.  There must be at
+// least one.
+u64 table_find_free(table_t *table, u64 hash)
+{
+  u64 mask = table->capacity - 1;
+  for (u64 pos = HASH_H1(hash) & mask, stride = 0;;
+       stride += TABLE_GROUP_SIZE, pos = (pos + stride) & mask)
+  {
+    u32 matches = group_match_free(table->ctrl + pos);
+    if (matches)
+      return (pos + __builtin_ctz(matches)) & mask;
+  }
+}
+
+void table_set_ctrl(table_t *table, u64 slot, u8 byte)
+{
+  table->ctrl[slot] = byte;
+  // Keep the copy of the first group in sync.
+  if (slot < TABLE_GROUP_SIZE)
+    table->ctrl[table->capacity + slot] = byte;
+}
+
+// Rebuild TABLE with enough capacity for COUNT entries, dropping any erased
+// entries.
+void table_rehash(table_t *table, u64 count)
+{
+  // Keep the load factor at or below 7/8.
+  u64 capacity = TABLE_GROUP_SIZE;
+  while (capacity - capacity / 8 < count)
+    capacity *= 2;
+
+  free(table->ctrl);
+  free(table->slots);
+  table->capacity = capacity;
+  table->ctrl     = malloc(capacity + TABLE_GROUP_SIZE);
+  table->slots    = malloc(capacity * sizeof(*table->slots));
+  memset(table->ctrl, CTRL_EMPTY, capacity + TABLE_GROUP_SIZE);
+
+  // Compact the entries, keeping them in order, and slot them back in.  We
+  // stored their hashes, so there's no need to look at any keys.
+  u64 live = 0;
+  for (u64 i = 0; i < table->entries.count; ++i)
+  {
+    table_entry_t entry = table->entries.data[i];
+    if (entry.erased)
+      continue;
+    u64 slot                  = table_find_free(table, entry.hash);
+    table->slots[slot]        = live;
+    table->entries.data[live] = entry;
+    table_set_ctrl(table, slot, HASH_H2(entry.hash));
+    ++live;
+  }
+  table->entries.count = live;
+  table->size          = live;
+  table->used          = live;
+}
+
+void table_reserve(table_t *table, u64 count)
+{
+  if (!table)
+    return;
+  if (table->capacity - table->capacity / 8 < count)
+    table_rehash(table, count);
+  table_entries_reserve(&table->entries, count);
+}
+
+void table_set(table_t *table, sv_t key, u64 value)
+{
+  assert(table && "Expected valid pointer");
+  u64 hash = sv_hash(key);
+  u64 slot = table_find(table, key, hash);
+  if (slot < table->capacity)
+  {
+    table->entries.data[table->slots[slot]].value = value;
+    return;
+  }
+
+  // Deleted slots count against the load factor, so rehashing may just clear
+  // them out rather than growing.  Erased entries are only dropped by
+  // rehashing too, and deleted slots get reused, so also rehash once erased
+  // entries outnumber live ones; otherwise churn grows the entries forever.
+  u64 erased = table->entries.count - table->size;
+  if (table->used + 1 > table->capacity - table->capacity / 8 ||
+      erased >= MAX(table->size, TABLE_GROUP_SIZE))
+    table_rehash(table, MAX(table->size * 2, table->size + 1));
+
+  slot = table_find_free(table, hash);
+  if (table->ctrl[slot] == CTRL_EMPTY)
+    ++table->used;
+  ++table->size;
+  table->slots[slot] = table->entries.count;
+  table_set_ctrl(table, slot, HASH_H2(hash));
+  table_entries_push(&table->entries, (table_entry_t){
+                                          .key   = key,
+                                          .value = value,
+                                          .hash  = hash,
+                                      });
+}
+
+u64 *table_get(table_t *table, sv_t key)
+{
+  assert(table && "Expected valid pointer");
+  u64 slot = table_find(table, key, sv_hash(key));
+  if (slot >= table->capacity)
+    return NULL;
+  return &table->entries.data[table->slots[slot]].value;
+}
+
+bool table_erase(table_t *table, sv_t key)
+{
+  assert(table && "Expected valid pointer");
+  u64 slot = table_find(table, key, sv_hash(key));
+  if (slot >= table->capacity)
+    return false;
+  table->entries.data[table->slots[slot]].erased = true;
+  table_set_ctrl(table, slot, CTRL_DELETED);
+  --table->size;
+  return true;
+}
+
+table_entry_t *table_next(table_t *table, u64 *iter)
+{
+  assert(table && iter && "Expected valid pointers");
+  while (*iter < table->entries.count)
+  {
+    table_entry_t *entry = table->entries.data + (*iter)++;
+    if (!entry->erased)
+      return entry;
+  }
+  return NULL;
+}
+
+void table_free(table_t *table)
+{
+  if (!table)
+    return;
+  free(table->ctrl);
+  free(table->slots);
+  table_entries_free(&table->entries);
+  *table = (table_t){0};
+}
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
@@ -0,0 +1,95 @@
+/* utf8.c: UTF-8 validation implementation
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary: See /include/arl/lib/utf8.h
+ */
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <arl/lib/utf8.h>
+
+u64 utf8_validate(const sv_t sv)
+{
+  const u8 *bytes = (const u8 *)sv.data;
+  u64 i           = 0;
+  while (i < sv.size)
+  {
+    // Source code is overwhelmingly ASCII, so skip over it a block at a time
+    // and only decode sequences when we find a byte with the top bit set.
+#ifdef __SSE2__
+    if (i + 16 <= sv.size &&
+        !_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(bytes + i))))
+    {
+      i += 16;
+      continue;
+    }
+#else
+    u64 block = 0;
+    if (i + 8 <= sv.size)
+      memcpy(&block, bytes + i, sizeof(block));
+    if (i + 8 <= sv.size && !(block & 0x8080808080808080))
+    {
+      i += 8;
+      continue;
+    }
+#endif
+
+    u8 lead = bytes[i];
+    if (lead < 0x80)
+    {
+      ++i;
+      continue;
+    }
+
+    // Work out the length of the sequence, and the range its second byte must
+    // lie in to rule out overlong encodings, surrogates and anything past
+    // U+10FFFF.
+    u64 size = 0;
+    u8 lo = 0x80, hi = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+      size = 2;
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+      size = 3;
+      if (lead == 0xE0)
+        lo = 0xA0;
+      else if (lead == 0xED)
+        hi = 0x9F;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+      size = 4;
+      if (lead == 0xF0)
+        lo = 0x90;
+      else if (lead == 0xF4)
+        hi = 0x8F;
+    }
+    else
+      return i;
+
+    if (i + size > sv.size || bytes[i + 1] < lo || bytes[i + 1] > hi)
+      return i;
+    for (u64 j = 2; j < size; ++j)
+      if (!UTF8_IS_CONTINUATION(bytes[i + j]))
+        return i;
+    i += size;
+  }
+  return sv.size;
+}
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
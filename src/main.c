@@ -7,11 +7,13 @@
 
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <arl/lexer/cache.h>
 #include <arl/lexer/lexer.h>
 #include <arl/lexer/token.h>
 #include <arl/lib/base.h>
@@ -20,23 +22,119 @@
 
 #include <arl/cli.h>
 
+/// Number of lexer errors reported before giving up, if not set by the user.
+#define DEFAULT_MAX_ERRORS 32
+
+// Lexes CONTENTS into TOKENS, reporting every error (up to MAX_ERRORS) against
+// FILENAME.  Returns the number of errors.
+u64 lex_and_report(const char *filename, sv_t contents, u64 max_errors,
+                   token_stream_t *tokens)
+{
+  lex_diags_t diags   = {0};
+  lex_stream_t stream = {.byte = 0, .contents = contents};
+  u64 errors = lex_stream_recover(tokens, &stream, &diags, max_errors);
+
+  // Diagnostics are in order of occurrence, so we can compute their positions
+  // in one walk of the buffer.
+  u64 line = 1, col = 0, walked = 0;
+  for (u64 i = 0; i < errors; ++i)
+  {
+    lex_diag_t diag = diags.data[i];
+    lex_stream_walk_line_col(&stream, walked, diag.byte, &line, &col);
+    walked = diag.byte;
+
+    LOG_ERR("%s:%lu:%lu: %s\n", filename, line, col,
+            lex_err_to_string(diag.err));
+  }
+  if (errors && errors == max_errors && stream.byte < stream.contents.size)
+    LOG_ERR("%s: Too many errors (%lu), stopping\n", filename, errors);
+
+  lex_diags_free(&diags);
+  return errors;
+}
+
 int main(int argc, char *argv[])
 {
-  int ret        = 0;
-  char *filename = "";
-  if (argc == 1)
+  int ret               = 0;
+  char *filename        = NULL;
+  char *cache_file      = NULL;
+  bool watch            = false;
+  u64 max_errors        = DEFAULT_MAX_ERRORS;
+  sv_t contents         = {0};
+  token_stream_t tokens = {0};
+  watch_t watcher       = {0};
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--max-errors") == 0)
+    {
+      // strtoull would happily skip whitespace and negate a leading minus, so
+      // insist on nothing but digits.
+      char *end = NULL;
+      if (i + 1 < argc && isdigit(argv[i + 1][0]))
+      {
+        errno      = 0;
+        max_errors = strtoull(argv[++i], &end, 10);
+      }
+      if (!end || *end != '\0' || errno == ERANGE)
+      {
+        LOG_ERR("ERROR: Expected a number after `--max-errors`\n");
+        usage(stderr);
+        ret = 1;
+        goto end;
+      }
+    }
+    else if (strcmp(argv[i], "--token-cache") == 0)
+    {
+      if (i + 1 == argc)
+      {
+        LOG_ERR("ERROR: Expected a file after `--token-cache`\n");
+        usage(stderr);
+        ret = 1;
+        goto end;
+      }
+      cache_file = argv[++i];
+    }
+    else if (strcmp(argv[i], "--watch") == 0)
+    {
+      watch = true;
+    }
+    else if (!filename)
+    {
+      filename = argv[i];
+    }
+    else
+    {
+      usage(stderr);
+      ret = 1;
+      goto end;
+    }
+  }
+
+  if (!filename)
   {
     usage(stderr);
     ret = 1;
     goto end;
   }
-  else
+  else if (watch && strcmp(filename, "--") == 0)
+  {
+    LOG_ERR("ERROR: Cannot watch stdin\n");
+    ret = 1;
+    goto end;
+  }
+
+  // Start watching before the first read, so we can't miss any edits made
+  // while we're busy compiling.
+  if (watch && watch_init(&watcher, filename))
   {
-    filename = argv[1];
+    LOG_ERR("ERROR: Watching `%s`: ", filename);
+    perror("");
+    ret = 1;
+    goto end;
   }
 
-  int read_err  = 0;
-  sv_t contents = {0};
+  int read_err = 0;
   if (strcmp(filename, "--") == 0)
   {
     filename = "stdin";
@@ -57,29 +155,95 @@ int main(int argc, char *argv[])
 
   LOG("%s => `" PR_SV "`\n", filename, SV_FMT(contents));
 
-  lex_stream_t stream   = {.byte = 0, .contents = contents};
-  token_stream_t tokens = {0};
-  lex_err_t perr        = lex_stream(&tokens, &stream);
-  if (perr)
+  if (cache_file)
   {
-    u64 line = 1, col = 0;
-    lex_stream_get_line_col(&stream, &line, &col);
+    token_cache_t cache    = {0};
+    token_cache_err_t cerr = token_cache_map(cache_file, contents, &cache);
+    if (!cerr)
+    {
+      token_cache_load(&cache, contents, &tokens);
+      token_cache_unmap(&cache);
+      LOG("Loaded tokens from `%s`\n", cache_file);
+      goto lexed;
+    }
+    LOG("Not using token cache `%s`: %s\n", cache_file,
+        token_cache_err_to_string(cerr));
+  }
 
-    LOG_ERR("%s:%lu:%lu: %s\n", filename, line, col, lex_err_to_string(perr));
+  if (lex_and_report(filename, contents, max_errors, &tokens))
+  {
     ret = 1;
-    goto end;
+    // In watch mode, the next edit may well fix things; but we have no good
+    // state to work incrementally from, so start again from nothing.
+    if (!watch)
+      goto end;
+    token_stream_free(&tokens);
+    tokens = (token_stream_t){0};
+    free(contents.data);
+    contents = (sv_t){0};
+  }
+  else if (cache_file)
+  {
+    FILE *fp = fopen(cache_file, "wb");
+    if (!fp || token_cache_write(fp, &tokens, contents))
+    {
+      LOG_ERR("WARNING: Writing token cache `%s`: ", cache_file);
+      perror("");
+    }
+    if (fp)
+      fclose(fp);
   }
 
+lexed:
 #if VERBOSE_LOGS
-  LOG("Lexed %lu tokens ", tokens.vec.size / sizeof(token_t));
+  LOG("Lexed %lu tokens ", tokens.vec.count);
   token_stream_print(stdout, &tokens);
   printf("\n");
 #endif
 
+  // CONTENTS and TOKENS always hold the last source that lexed successfully,
+  // so every edit can be lexed incrementally from them.
+  while (watch && !watch_wait(&watcher))
+  {
+    sv_t next = {0};
+    if (read_file(filename, &next))
+    {
+      LOG_ERR("ERROR: Reading `%s`: ", filename);
+      perror("");
+      continue;
+    }
+
+    lex_stream_t stream = {.byte = 0, .contents = next};
+    if (lex_stream_relex(&tokens, contents, &stream))
+    {
+      // Relexing stops at the first error, so lex the whole thing again to
+      // report all of them.
+      token_stream_t scratch = {0};
+      lex_and_report(filename, next, max_errors, &scratch);
+      token_stream_free(&scratch);
+      free(next.data);
+      ret = 1;
+      continue;
+    }
+
+    if (contents.data)
+      free(contents.data);
+    contents = next;
+    ret      = 0;
+    LOG_ERR("%s: OK\n", filename);
+
+#if VERBOSE_LOGS
+    LOG("Lexed %lu tokens ", tokens.vec.count);
+    token_stream_print(stdout, &tokens);
+    printf("\n");
+#endif
+  }
+
 end:
   if (contents.data)
     free(contents.data);
   token_stream_free(&tokens);
+  watch_free(&watcher);
   return ret;
 }
 
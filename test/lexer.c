@@ -0,0 +1,255 @@
+/* lexer.c: Tests for the lexer
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary: See /include/arl/lexer/lexer.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arl/lexer/lexer.h>
+#include <arl/lexer/token.h>
+#include <arl/lib/utf8.h>
+
+#define RELEX_SEED       1
+#define RELEX_SESSIONS   2000
+#define RELEX_EDITS      50
+#define RELEX_MAX_SOURCE 256
+
+/// Prototypes for helpers
+void assert_same_stream(token_stream_t *got, token_stream_t *expected);
+u64 random_edit(char *buffer, u64 size);
+
+/// Prototypes for tests
+void test_utf8_validate(void);
+void test_recover_utf8(void);
+void test_relex(void);
+
+#define PIECE(S) {.data = (S), .size = sizeof(S) - 1}
+
+// Pieces edits are made of: whole tokens, whitespace, fragments of strings
+// (including escaped speech marks and raw NULs) and multi-byte characters.
+static const sv_t PIECES[] = {
+    PIECE("a"),    PIECE("xyz"),  PIECE("puts"), PIECE("pu"),
+    PIECE("ts"),   PIECE("\""),   PIECE("\\\""), PIECE("\\n"),
+    PIECE("\\"),   PIECE("\"hi\""), PIECE(" "),    PIECE("\n"),
+    PIECE("\t"),   PIECE("é"),    PIECE("€"),    PIECE("😀"),
+    PIECE("\xe2"), PIECE("\x82"), PIECE("0"),    PIECE("1a"),
+    PIECE("\0"),   PIECE("\"\0\""),
+};
+
+// Inputs to utf8_validate, with the length of their valid prefix.
+static const struct
+{
+  sv_t input;
+  u64 valid;
+} UTF8_CASES[] = {
+    {PIECE(""), 0},
+    {PIECE("ascii"), 5},
+    {PIECE("é€😀"), 9},
+    // Overlong encodings
+    {PIECE("\xc0\x80"), 0},
+    {PIECE("\xc1\xbf"), 0},
+    {PIECE("a\xe0\x80\xaf"), 1},
+    {PIECE("\xe0\x9f\xbf"), 0},
+    {PIECE("\xe0\xa0\x80"), 3},
+    {PIECE("\xf0\x80\x80\xaf"), 0},
+    {PIECE("\xf0\x8f\xbf\xbf"), 0},
+    {PIECE("\xf0\x90\x80\x80"), 4},
+    // Surrogates, and the characters either side of them
+    {PIECE("\xed\x9f\xbf"), 3},
+    {PIECE("a\xed\xa0\x80"), 1},
+    {PIECE("\xed\xbf\xbf"), 0},
+    {PIECE("\xee\x80\x80"), 3},
+    // Past U+10FFFF
+    {PIECE("\xf4\x8f\xbf\xbf"), 4},
+    {PIECE("\xf4\x90\x80\x80"), 0},
+    {PIECE("\xf5\x80\x80\x80"), 0},
+    {PIECE("\xff"), 0},
+    // Truncated sequences and stray continuation bytes
+    {PIECE("ab\xe2\x82"), 2},
+    {PIECE("\xe2\x82x"), 0},
+    {PIECE("\xf0\x9f\x98"), 0},
+    {PIECE("\xc3"), 0},
+    {PIECE("a\x80"), 1},
+    {PIECE("é\xa9"), 2},
+    // Past the first group of 16 bytes, and straddling the boundary
+    {PIECE("0123456789abcdef0123456789abcdef01234\xff"), 37},
+    {PIECE("0123456789abcde€"), 18},
+    {PIECE("0123456789abcde\xe2\x82"), 15},
+};
+
+// Check GOT matches EXPECTED token for token, both lexed from the same buffer:
+// symbols must view the same bytes, and strings the same literals.
+void assert_same_stream(token_stream_t *got, token_stream_t *expected)
+{
+  assert(got->vec.count == expected->vec.count);
+  assert(literal_pool_count(&got->literals) ==
+         literal_pool_count(&expected->literals));
+  for (u64 i = 0; i < got->vec.count; ++i)
+  {
+    token_t x = got->vec.data[i], y = expected->vec.data[i];
+    assert(x.byte_location == y.byte_location);
+    assert(x.type == y.type);
+    switch (x.type)
+    {
+    case TOKEN_TYPE_KNOWN:
+      assert(x.as_known == y.as_known);
+      break;
+    case TOKEN_TYPE_SYMBOL:
+      assert(x.as_symbol.data == y.as_symbol.data);
+      assert(x.as_symbol.size == y.as_symbol.size);
+      break;
+    case TOKEN_TYPE_STRING:
+    {
+      assert(x.as_string.index == y.as_string.index);
+      assert(x.as_string.size == y.as_string.size);
+      sv_t a = literal_pool_get(&got->literals, x.as_string.index);
+      sv_t b = literal_pool_get(&expected->literals, y.as_string.index);
+      assert(a.size == b.size && memcmp(a.data, b.data, a.size) == 0);
+      break;
+    }
+    default:
+      FAIL("Unexpected token type: %d\n", x.type);
+    }
+  }
+}
+
+void test_utf8_validate(void)
+{
+  for (u64 i = 0; i < ARRSIZE(UTF8_CASES); ++i)
+    assert(utf8_validate(UTF8_CASES[i].input) == UTF8_CASES[i].valid);
+}
+
+// Recovering reports each invalid sequence once, at its first byte, and lexes
+// nothing.
+void test_recover_utf8(void)
+{
+  // Overlong, surrogate, past U+10FFFF, stray continuation, truncated.
+  char source[] = "a \xc0\xaf b\xed\xa0\x80 \xf4\x90\x80\x80 \"\x80\" \xe2\x82";
+  u64 expected[] = {2, 6, 10, 16, 19};
+
+  for (u64 max_errors = 0; max_errors <= ARRSIZE(expected) + 1; ++max_errors)
+  {
+    token_stream_t tokens = {0};
+    lex_diags_t diags     = {0};
+    lex_stream_t stream   = {.contents = SV(source, sizeof(source) - 1)};
+
+    u64 errors = lex_stream_recover(&tokens, &stream, &diags, max_errors);
+
+    u64 reported = max_errors ? MIN(max_errors, ARRSIZE(expected))
+                              : ARRSIZE(expected);
+    assert(errors == reported && diags.count == reported);
+    for (u64 i = 0; i < reported; ++i)
+    {
+      assert(diags.data[i].err == LEX_ERR_INVALID_UTF8);
+      assert(diags.data[i].byte == expected[i]);
+    }
+    assert(tokens.vec.count == 0);
+
+    lex_diags_free(&diags);
+    token_stream_free(&tokens);
+  }
+}
+
+// Insert a random piece into, or delete a random range from, the SIZE bytes of
+// BUFFER (which has space for RELEX_MAX_SOURCE).  Returns the new size.
+u64 random_edit(char *buffer, u64 size)
+{
+  u64 at = rand() % (size + 1);
+  if (size && rand() % 3 == 0)
+  {
+    u64 count = 1 + rand() % MIN(size - at + 1, 4);
+    count     = MIN(count, size - at);
+    memmove(buffer + at, buffer + at + count, size - at - count);
+    return size - count;
+  }
+
+  sv_t piece = PIECES[rand() % ARRSIZE(PIECES)];
+  if (size + piece.size > RELEX_MAX_SOURCE)
+    return size;
+  memmove(buffer + at + piece.size, buffer + at, size - at);
+  memcpy(buffer + at, piece.data, piece.size);
+  return size + piece.size;
+}
+
+// Apply random edits in sequence, as if someone were typing in watch mode.
+// After each one, relexing must give exactly what lexing the new buffer from
+// scratch would; if the edit broke the buffer, relexing must fail the same way
+// and leave the tokens as they were.
+void test_relex(void)
+{
+  srand(RELEX_SEED);
+  for (u64 session = 0; session < RELEX_SESSIONS; ++session)
+  {
+    char old[RELEX_MAX_SOURCE], new[RELEX_MAX_SOURCE];
+    u64 old_size          = 0;
+    token_stream_t tokens = {0};
+
+    for (u64 edit = 0; edit < RELEX_EDITS; ++edit)
+    {
+      memcpy(new, old, old_size);
+      u64 new_size = random_edit(new, old_size);
+
+      token_stream_t fresh  = {0};
+      lex_stream_t stream   = {.contents = SV(new, new_size)};
+      lex_err_t err         = lex_stream(&fresh, &stream);
+      lex_stream_t relexing = {.contents = SV(new, new_size)};
+      lex_err_t relex_err =
+          lex_stream_relex(&tokens, SV(old, old_size), &relexing);
+      assert(err == relex_err);
+
+      if (err)
+      {
+        assert(stream.byte == relexing.byte);
+        // Nothing should have changed, so TOKENS still matches OLD.
+        token_stream_free(&fresh);
+        fresh  = (token_stream_t){0};
+        stream = (lex_stream_t){.contents = SV(old, old_size)};
+        assert(!lex_stream(&fresh, &stream));
+        assert_same_stream(&tokens, &fresh);
+        token_stream_free(&fresh);
+        continue;
+      }
+
+      assert_same_stream(&tokens, &fresh);
+
+      // Move NEW into OLD for the next edit; relexing an unchanged buffer
+      // should just rebase every token onto it.
+      memcpy(old, new, new_size);
+      old_size = new_size;
+      token_stream_free(&fresh);
+      fresh  = (token_stream_t){0};
+      stream = (lex_stream_t){.contents = SV(old, old_size)};
+      assert(!lex_stream(&fresh, &stream));
+      relexing = (lex_stream_t){.contents = SV(old, old_size)};
+      assert(!lex_stream_relex(&tokens, SV(new, new_size), &relexing));
+      assert_same_stream(&tokens, &fresh);
+      token_stream_free(&fresh);
+    }
+    token_stream_free(&tokens);
+  }
+}
+
+int main(void)
+{
+  test_utf8_validate();
+  test_recover_utf8();
+  test_relex();
+  printf("lexer: OK\n");
+  return 0;
+}
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */
@@ -0,0 +1,113 @@
+/* table.c: Tests for hash tables
+ * Created: 2026-10-19
+ * Author: Aryadev Chavali
+ * License: See end of file
+ * Commentary: See /include/arl/lib/table.h
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <arl/lib/table.h>
+
+#define CHURN_CYCLES 100000
+#define KEYS         1000
+
+/// Prototypes for tests
+void test_set_get_erase(void);
+void test_churn_one_key(void);
+void test_churn_many_keys(void);
+
+void test_set_get_erase(void)
+{
+  table_t table = {0};
+  table_set(&table, SV("a", 1), 1);
+  table_set(&table, SV("b", 1), 2);
+  table_set(&table, SV("a", 1), 3);
+  assert(table.size == 2);
+  assert(*table_get(&table, SV("a", 1)) == 3);
+  assert(*table_get(&table, SV("b", 1)) == 2);
+  assert(!table_get(&table, SV("c", 1)));
+
+  assert(table_erase(&table, SV("a", 1)));
+  assert(!table_erase(&table, SV("a", 1)));
+  assert(!table_get(&table, SV("a", 1)));
+  assert(table.size == 1);
+  table_free(&table);
+}
+
+// Erasing and reinserting a key must not grow the table without limit.
+void test_churn_one_key(void)
+{
+  table_t table = {0};
+  sv_t key      = SV("key", 3);
+  for (u64 i = 0; i < CHURN_CYCLES; ++i)
+  {
+    table_set(&table, key, i);
+    assert(table_erase(&table, key));
+  }
+  assert(table.size == 0);
+  assert(table.entries.count <= TABLE_GROUP_SIZE);
+  assert(table.capacity <= 2 * TABLE_GROUP_SIZE);
+
+  u64 iter = 0;
+  assert(!table_next(&table, &iter));
+  table_free(&table);
+}
+
+// Churn half of a larger table, checking the other half survives in insertion
+// order.
+void test_churn_many_keys(void)
+{
+  static char names[KEYS][8];
+  table_t table = {0};
+  for (u64 i = 0; i < KEYS; ++i)
+  {
+    u64 size = snprintf(names[i], sizeof(names[i]), "k%lu", i);
+    table_set(&table, SV(names[i], size), i);
+  }
+
+  for (u64 cycle = 0; cycle < CHURN_CYCLES / KEYS; ++cycle)
+    for (u64 i = 1; i < KEYS; i += 2)
+    {
+      sv_t key = SV(names[i], strlen(names[i]));
+      assert(table_erase(&table, key));
+      table_set(&table, key, i);
+    }
+  assert(table.size == KEYS);
+  assert(table.entries.count <= 2 * KEYS);
+
+  u64 iter = 0, expected = 0;
+  for (table_entry_t *entry; (entry = table_next(&table, &iter));)
+  {
+    if (entry->value % 2)
+      continue;
+    assert(entry->value == expected);
+    expected += 2;
+  }
+  assert(expected == KEYS);
+  for (u64 i = 0; i < KEYS; ++i)
+    assert(*table_get(&table, SV(names[i], strlen(names[i]))) == i);
+  table_free(&table);
+}
+
+int main(void)
+{
+  test_set_get_erase();
+  test_churn_one_key();
+  test_churn_many_keys();
+  printf("table: OK\n");
+  return 0;
+}
+
+/* Copyright (C) 2026 Aryadev Chavali
+
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the MIT License for details.
+
+ * You may distribute and modify this code under the terms of the MIT License,
+ * which you should have received a copy of along with this program.  If not,
+ * please go to <https://opensource.org/license/MIT>.
+
+ */